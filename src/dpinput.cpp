@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <regex>
+#include <cstdlib>
 using namespace std;
 
 #define PAGE_SIZE 7
@@ -30,8 +31,54 @@ struct PinyinBase {
     unordered_set<string> all;
     unordered_multimap<string, string> reversed; // digits -> [pinyin]
     Trie jp_all; //prefix tree for all supported jianpin
+    PackedWordSet jp_packed; // compact jianpin set used under a memory budget
+    bool packed {false};
+    size_t jp_max_len {0}; // jianpin length cutoff, 0 means none in trie mode
+
+    bool isJianpin(const string& s) {
+        return packed ? jp_packed.search(s) : jp_all.search(s);
+    }
+};
+
+// Approximate heap bytes owned by a std::string beyond its own footprint.
+static size_t stringHeapBytes(const string& s)
+{
+    return s.capacity() > string().capacity() ? s.capacity() + 1 : 0;
+}
+
+// Approximate heap bytes of a node based unordered container: the bucket
+// array plus one node (next pointer, value, cached hash) per element.
+template <class Container>
+static size_t hashTableBytes(const Container& c)
+{
+    return c.bucket_count() * sizeof(void*) +
+        c.size() * (sizeof(void*) + sizeof(typename Container::value_type) + sizeof(size_t));
+}
+
+struct PinyinMemoryUsage {
+    size_t all;
+    size_t reversed;
+    size_t jianpin;
+
+    size_t total() const { return all + reversed + jianpin; }
 };
 
+static PinyinMemoryUsage pinyinMemoryUsage(const PinyinBase* db)
+{
+    PinyinMemoryUsage usage;
+
+    usage.all = hashTableBytes(db->all);
+    for (const auto& s: db->all)
+        usage.all += stringHeapBytes(s);
+
+    usage.reversed = hashTableBytes(db->reversed);
+    for (const auto& kv: db->reversed)
+        usage.reversed += stringHeapBytes(kv.first) + stringHeapBytes(kv.second);
+
+    usage.jianpin = db->packed ? db->jp_packed.memoryUsage() : db->jp_all.memoryUsage();
+    return usage;
+}
+
 typedef struct _FcitxDPState {
     pinyin_context_t *py_ctx;
     pinyin_instance_t *py_inst;
@@ -146,7 +193,7 @@ class Digits2Pinyin {
     private:
         //可能是简拼
         bool isJianpin(PinyinBase* db, const string& s) {
-            if (db->jp_all.search(s)) {
+            if (db->isJianpin(s)) {
                 //cerr << s << " may be jianpin" << endl;
                 return true;
             }
@@ -233,6 +280,68 @@ static ostream& operator<<(ostream& os, const vector<string>& v)
 }
 
 
+// Reads a size from the environment, returns 0 if unset or malformed.
+static size_t envSize(const char* name)
+{
+    const char* v = getenv(name);
+    if (!v || !*v)
+        return 0;
+
+    char* end = NULL;
+    unsigned long long n = strtoull(v, &end, 10);
+    return *end ? 0 : n;
+}
+
+// Loads jianpin.txt. Without a budget every entry goes into the pointer
+// trie. With a budget (bytes left after the pinyin tables) entries are
+// packed into a PackedWordSet and only the longest length cutoff whose
+// entries still fit is kept, so short and more useful jianpin survive.
+static void loadJianpin(PinyinBase* db, const string& file, size_t budget, size_t max_len)
+{
+    if (!budget) {
+        if (ifstream py_fs{file, std::ios::in}) {
+            for (std::array<char, 15> a; py_fs.getline(&a[0], 15);) {
+                if (max_len && strlen(a.data()) > max_len)
+                    continue;
+                db->jp_all.insert(a.data());
+            }
+        }
+        db->jp_max_len = max_len;
+        return;
+    }
+
+    db->packed = true;
+    if (!max_len || max_len > PackedWordSet::MaxLength)
+        max_len = PackedWordSet::MaxLength;
+
+    // count entries per length to pick the cutoff before inserting anything
+    vector<size_t> counts(max_len + 1, 0);
+    if (ifstream py_fs{file, std::ios::in}) {
+        for (std::array<char, 15> a; py_fs.getline(&a[0], 15);) {
+            size_t len = strlen(a.data());
+            if (len <= max_len && PackedWordSet::packable(a.data()))
+                counts[len]++;
+        }
+    }
+
+    size_t cap = budget / sizeof(uint64_t), n = 0, cutoff = 0;
+    for (size_t len = 0; len <= max_len; len++) {
+        if (n + counts[len] > cap)
+            break;
+        n += counts[len];
+        cutoff = len;
+    }
+    db->jp_packed.reserve(n);
+
+    if (ifstream py_fs{file, std::ios::in}) {
+        for (std::array<char, 15> a; py_fs.getline(&a[0], 15);) {
+            if (strlen(a.data()) <= cutoff)
+                db->jp_packed.insert(a.data());
+        }
+    }
+    db->jp_max_len = cutoff;
+}
+
 static void* DPCreate(struct _FcitxInstance* instance);
 INPUT_RETURN_VALUE DoDPInput(void* arg, FcitxKeySym sym, unsigned int state);
 INPUT_RETURN_VALUE DPGetCandWords(void *arg);
@@ -312,16 +421,29 @@ void* DPCreate(struct _FcitxInstance* instance)
         string file(pkgdatadir);
         file += "/dpinput/jianpin.txt";
 
-        FcitxLog(INFO, "load %s", file.c_str());
-        if (ifstream py_fs{file, std::ios::in}) {
-            for (std::array<char, 15> a; py_fs.getline(&a[0], 15);) {
-                dpstate->py->jp_all.insert(a.data());
-            }
+        // budget is given in KiB and covers all pinyin tables
+        size_t budget = envSize("DPINPUT_MEMORY_BUDGET") * 1024;
+        size_t max_len = envSize("DPINPUT_JIANPIN_MAX_LEN");
+        if (budget) {
+            size_t used = pinyinMemoryUsage(dpstate->py).total();
+            budget = budget > used ? budget - used : 1;
         }
+
+        FcitxLog(INFO, "load %s", file.c_str());
+        loadJianpin(dpstate->py, file, budget, max_len);
     }
 
     free(pkgdatadir);
 
+    {
+        auto usage = pinyinMemoryUsage(dpstate->py);
+        FcitxLog(INFO, "memory: pinyin set %zu bytes, reversed map %zu bytes, "
+                "jianpin %s %zu bytes (max len %zu), total %zu bytes",
+                usage.all, usage.reversed,
+                dpstate->py->packed ? "packed" : "trie", usage.jianpin,
+                dpstate->py->jp_max_len, usage.total());
+    }
+
     return dpstate;
 }
 
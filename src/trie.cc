@@ -48,8 +48,10 @@ void Trie::insert(string word)
     auto *t = root;
     auto p = word.cbegin();
     while (p != word.cend()) {
-        if (!t->children[ORD(*p)])
+        if (!t->children[ORD(*p)]) {
             t->children[ORD(*p)] = new TrieNode();
+            nodes++;
+        }
         t = t->children[ORD(*p)];
         p++;
     }
@@ -87,6 +89,74 @@ bool Trie::startsWith(string prefix)
     return true;
 }
 
+size_t Trie::memoryUsage() const
+{
+    return nodes * sizeof(TrieNode);
+}
+
+static uint64_t pack(const string& word)
+{
+    uint64_t code = 0;
+    for (size_t i = 0; i < word.size(); i++) {
+        code |= (uint64_t)(ORD(word[i]) + 1) << (5 * (PackedWordSet::MaxLength - 1 - i));
+    }
+    return code;
+}
+
+bool PackedWordSet::packable(const string& word)
+{
+    if (word.size() > MaxLength)
+        return false;
+    return all_of(word.cbegin(), word.cend(), [](char c) {
+        return c >= 'a' && c <= 'z';
+    });
+}
+
+// Inserts a word into the set. Input sorted in advance (like jianpin.txt)
+// only ever appends.
+void PackedWordSet::insert(string word)
+{
+    if (!packable(word))
+        return;
+
+    auto code = pack(word);
+    if (codes.empty() || codes.back() < code) {
+        codes.push_back(code);
+        return;
+    }
+
+    auto p = lower_bound(codes.begin(), codes.end(), code);
+    if (*p != code)
+        codes.insert(p, code);
+}
+
+// Returns if the word is in the set.
+bool PackedWordSet::search(string word)
+{
+    if (!packable(word))
+        return false;
+    return binary_search(codes.cbegin(), codes.cend(), pack(word));
+}
+
+// Returns if there is any word in the set
+// that starts with the given prefix.
+bool PackedWordSet::startsWith(string prefix)
+{
+    if (!packable(prefix))
+        return false;
+
+    // words sharing the prefix only differ in the low bits left over
+    auto lo = pack(prefix);
+    auto hi = lo | ((uint64_t(1) << (5 * (MaxLength - prefix.size()))) - 1);
+    auto p = lower_bound(codes.cbegin(), codes.cend(), lo);
+    return p != codes.cend() && *p <= hi;
+}
+
+size_t PackedWordSet::memoryUsage() const
+{
+    return codes.capacity() * sizeof(uint64_t);
+}
+
 static int test_trie()
 {
     Trie trie;
@@ -100,5 +170,15 @@ static int test_trie()
     assert(trie.startsWith("algo") == true);
     assert(trie.startsWith("algorith") == true);
 
+    PackedWordSet packed;
+    packed.insert("bad");
+    packed.insert("algo");
+    packed.insert("baby");
+    assert(packed.search("algo") == true);
+    assert(packed.search("alg") == false);
+    assert(packed.startsWith("ba") == true);
+    assert(packed.startsWith("bab") == true);
+    assert(packed.startsWith("bc") == false);
+
     return 0;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <cstdint>
 
 class TrieNode;
 class Trie {
@@ -15,7 +17,37 @@ public:
     // Returns if there is any word in the trie
     // that starts with the given prefix.
     bool startsWith(std::string prefix);
+    // Returns approximate heap bytes held by all nodes.
+    size_t memoryUsage() const;
 
 private:
     TrieNode* root;
+    size_t nodes {1};
+};
+
+// Sorted array of words packed five bits per letter into a 64-bit code,
+// a compact replacement for Trie when memory is tight. Only words made of
+// a-z and no longer than MaxLength can be stored.
+class PackedWordSet {
+public:
+    static const size_t MaxLength = 12;
+
+    // Returns if the word fits into a packed code.
+    static bool packable(const std::string& word);
+
+    // Inserts a word, ignoring words that are not packable.
+    void insert(std::string word);
+    // Returns if the word is in the set.
+    bool search(std::string word);
+    // Returns if there is any word in the set
+    // that starts with the given prefix.
+    bool startsWith(std::string prefix);
+
+    void reserve(size_t n) { codes.reserve(n); }
+    size_t size() const { return codes.size(); }
+    // Returns approximate heap bytes held by the set.
+    size_t memoryUsage() const;
+
+private:
+    std::vector<uint64_t> codes;
 };